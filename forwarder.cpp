@@ -27,11 +27,44 @@
 using namespace TelEngine;
 namespace { // anonymous
 
+class ForwardTarget : public String
+{
+public:
+    ForwardTarget(const char* number, const char* delay)
+        : String(number), m_delay(delay), m_routed(0) {
+    }
+
+    inline String& getDelay() {
+        return m_delay;
+    }
+
+    inline void setRoute(const String& callto) {
+        m_callto = callto;
+        m_routed = Time::now();
+    }
+
+    // cached route, empty if missing or older than expire ms
+    inline const String& getRoute(unsigned int expire) const {
+        if (m_callto.null() || (expire && (Time::now() > m_routed + (u_int64_t)expire * 1000)))
+            return String::empty();
+        return m_callto;
+    }
+
+private:
+    String m_delay;
+    String m_callto;
+    u_int64_t m_routed;
+};
+
 class ForwardRec : public NamedString
 {
 public:
-    ForwardRec(const char* name, const char* value, const char* forwardTo, const char* delay, RefObject* userData)
-        : NamedString(name, value), m_forwardTo(forwardTo), m_delay(delay), m_userData(userData) {
+    enum Mode {
+        Parallel,
+        Sequential
+    };
+    ForwardRec(const char* name, const char* value, const char* delay, int mode, RefObject* userData)
+        : NamedString(name, value), m_delay(delay), m_mode(mode), m_serial(0), m_userData(userData) {
         if (m_userData)
             m_userData->ref();
     }
@@ -46,24 +79,103 @@ public:
         return NamedString::getObject(name);
     }
 
+    // add a comma separated list of numbers, each ringing for delay ms
+    void addTargets(const String& numbers, const String& delay) {
+        ObjList* lst = numbers.split(',', false);
+        for (ObjList* o = lst->skipNull(); o; o = o->skipNext()) {
+            String* s = static_cast<String*>(o->get());
+            s->trimBlanks();
+            if (s->null())
+                continue;
+            m_targets.append(new ForwardTarget(*s, delay));
+            m_forwardTo.append(*s, ",");
+        }
+        TelEngine::destruct(lst);
+    }
+
     inline String& getForwardTo() {
         return m_forwardTo;
     }
 
+    inline ObjList& getTargets() {
+        return m_targets;
+    }
+
     inline String& getDelay() {
         return m_delay;
     }
 
+    inline int getMode() const {
+        return m_mode;
+    }
+
+    inline unsigned int getSerial() const {
+        return m_serial;
+    }
+
+    inline void setSerial(unsigned int serial) {
+        m_serial = serial;
+    }
+
     inline RefObject* getUserData() {
         return m_userData;
     }
         
 private:
     String m_forwardTo;
+    ObjList m_targets;
     String m_delay;
+    int m_mode;
+    unsigned int m_serial;
     RefObject* m_userData;
 };
 
+// background call.route for a forward target, caches result in the target
+// the record may be gone when dispatched so only copies of its data are kept
+class ForwardRoute : public Message
+{
+public:
+    ForwardRoute(ForwardRec* rec, const String& number);
+    virtual ~ForwardRoute();
+    virtual void dispatched(bool accepted);
+private:
+    String m_id;
+    unsigned int m_serial;
+    String m_number;
+};
+
+// forward of a detached record, owns the record
+class ForwardJob : public GenObject
+{
+public:
+    ForwardJob(const String& id, ForwardRec* rec)
+        : m_id(id), m_rec(rec) {
+    }
+    virtual ~ForwardJob() {
+        TelEngine::destruct(m_rec);
+    }
+
+    inline const String& getId() const {
+        return m_id;
+    }
+
+    inline ForwardRec* getRec() {
+        return m_rec;
+    }
+
+private:
+    String m_id;
+    ForwardRec* m_rec;
+};
+
+class ForwardWorker : public Thread
+{
+public:
+    ForwardWorker();
+    virtual ~ForwardWorker();
+    virtual void run();
+};
+
 class ForwarderModule : public Module
 {
 public:
@@ -80,16 +192,126 @@ public:
     bool msgExecute(Message& msg);
     bool msgDisconnected(Message& msg);
     bool msgAnswered(Message& msg);
+    void routeStarted();
+    void routeDone();
+    void routed(const String& id, unsigned int serial, const String& number, const String& callto);
+    ForwardJob* getJob();
+    void jobDone(ForwardJob* job);
+    void forward(const String& id, ForwardRec* rec, bool drop);
+    void threadStarted();
+    void threadDone();
+protected:
+    virtual void statusParams(String& str);
 private:
+    void startWorkers();
+    bool waitWorkers(bool exited, int msec);
+    ForwardRec* findRec(const String& id);
+    bool routeTarget(ForwardRec* rec, ForwardTarget* target, String& callto);
+    bool buildCallto(ForwardRec* rec, Message& exec);
     bool m_init;
     HashList m_hash;
     String m_account;
     String m_get_query;
+    int m_mode;
+    bool m_preroute;
+    unsigned int m_preroute_expire;
+    unsigned int m_serial;
+    unsigned int m_routes;
     int m_disconnected_pri;
     int m_answered_pri;
     int m_execute_pri;
+    ObjList m_jobs;
+    unsigned int m_jobsCount;
+    Semaphore m_jobsSem;
+    bool m_stopping;
+    int m_workers;
+    int m_threads;
+    int m_maxWorkers;
+    unsigned int m_maxQueue;
+    unsigned int m_queued;
+    unsigned int m_queuePeak;
+    unsigned int m_overflow;
+    unsigned int m_forwarded;
+    unsigned int m_failed;
+    unsigned int m_canceled;
+    int m_busy;
+};
+
+static const TokenDict s_modes[] = {
+    { "parallel", ForwardRec::Parallel },
+    { "fork", ForwardRec::Parallel },
+    { "sequential", ForwardRec::Sequential },
+    { "hunt", ForwardRec::Sequential },
+    { 0, 0 }
+};
+
+// get forwarding mode by name, unlike lookup() numeric values are not accepted
+static int getMode(const String& name, int defMode)
+{
+    for (const TokenDict* d = s_modes; d->token; d++) {
+        if (name == d->token)
+            return d->value;
+    }
+    return defMode;
+}
+
+// get a cell from SQL result as string, empty if missing
+static String getCell(Array* a, int col, int row)
+{
+    if (col < 0 || col >= a->getColumns() || row >= a->getRows())
+        return String::empty();
+    String* s = YOBJECT(String,a->get(col,row));
+    return s ? *s : String::empty();
+}
+
+// find SQL result column by its name, -1 if not found
+static int findColumn(Array* a, const char* name)
+{
+    for (int i = 0; i < a->getColumns(); i++) {
+        String* s = YOBJECT(String,a->get(i,0));
+        if (s && (*s == name))
+            return i;
+    }
+    return -1;
+}
+
+// check if a call.route returned a usable callto
+static bool validRoute(Message& m, bool accepted)
+{
+    return accepted && !m.retValue().null() && (m.retValue() != "-") && (m.retValue() != "error");
+}
+
+enum {
+    CallerWaiting,
+    CallerConnected,
+    CallerGone
 };
 
+// check if the caller is still up and waiting for a new peer
+static int callerState(RefObject* data)
+{
+    CallEndpoint* ep = YOBJECT(CallEndpoint,data);
+    if (!ep)
+        return CallerGone;
+    if (ep->getPeer())
+        return CallerConnected;
+    // our reference keeps the channel around, look at its status instead
+    Channel* chan = YOBJECT(Channel,ep);
+    if (chan && (chan->status() == "hangup" || chan->status() == "dropped"))
+        return CallerGone;
+    return CallerWaiting;
+}
+
+// drop a caller whose chan.disconnected was accepted for a queued forward
+static void dropCaller(const String& id)
+{
+    Message* m = new Message("call.drop");
+    m->addParam("id", id);
+    m->addParam("reason", "noanswer");
+    if (!Engine::enqueue(m))
+        TelEngine::destruct(m);
+}
+
 // copy parameters from SQL result to a NamedList
 static void copyParams(NamedList& lst, Array* a)
 {
@@ -122,11 +344,64 @@ bool ForwarderModule::unload()
 {
     if (!lock(500000))
         return false;
+    if (m_routes) {
+        Debug(&__plugin, DebugNote, "%u preroutes still queued, cannot unload", m_routes);
+        unlock();
+        return false;
+    }
+    unlock();
+    // let the workers finish queued and running forwards before tearing down
+    if (!waitWorkers(false, 5000)) {
+        Debug(&__plugin, DebugNote, "Forwards still in progress, cannot unload");
+        return false;
+    }
+    // stop the workers, new forwards run inline meanwhile
+    if (!lock(500000))
+        return false;
+    m_stopping = true;
+    for (int i = 0; i < m_threads; i++)
+        m_jobsSem.unlock();
+    unlock();
+    bool exited = waitWorkers(true, 1000);
+    if (!lock(500000))
+        return false;
+    if (!exited || m_routes) {
+        Debug(&__plugin, DebugWarn, "Forwarder still busy, cannot unload");
+        m_stopping = false;
+        startWorkers();
+        unlock();
+        return false;
+    }
     uninstallRelays();
+    // forwards queued while stopping have no worker left to run them
+    while (ForwardJob* job = static_cast<ForwardJob*>(m_jobs.remove(false))) {
+        m_jobsCount--;
+        unlock();
+        Debug(&__plugin, DebugMild, "Forwarding call %s inline on unload", job->getId().c_str());
+        forward(job->getId(), job->getRec(), true);
+        TelEngine::destruct(job);
+        lock();
+    }
     unlock();
+    // worker threads may still be returning from their destructors
+    Thread::msleep(50);
     return true;
 }
 
+// wait until workers are idle with an empty queue or, if exited, all gone
+bool ForwarderModule::waitWorkers(bool exited, int msec)
+{
+    for (int i = 0; i < msec; i += 10) {
+        lock();
+        bool done = exited ? !m_threads : !(m_busy || m_jobsCount);
+        unlock();
+        if (done)
+            return true;
+        Thread::msleep(10);
+    }
+    return false;
+}
+
 bool ForwarderModule::msgExecute(Message& msg)
 {
     Message db("database");
@@ -150,6 +425,7 @@ bool ForwarderModule::msgExecute(Message& msg)
     
     if (result->getRows() <= 1 || result->getColumns() < 3) {
         Debug(&__plugin, DebugInfo, "Result array is empty");
+        return false;
     }
 
     NamedList lst("templist");
@@ -157,75 +433,343 @@ bool ForwarderModule::msgExecute(Message& msg)
     String dbg;
     lst.dump(dbg, ":", '"', true);
 
-    String delay = result->get(2,1)->toString();
+    // every row is a forward target (or a comma separated list of them),
+    // the mode column of the first row selects fork or hunt behaviour
+    String delay = getCell(result, 2, 1);
+    int mode = getMode(getCell(result, findColumn(result, "mode"), 1), m_mode);
     RefObject* data = msg.userData();
-    m_hash.append(new ForwardRec(msg.getValue("id"),
-                                 result->get(0, 1)->toString(),
-                                 result->get(1, 1)->toString(),
-                                 delay,
-                                 data));
-    Debug(&__plugin, DebugMild, "Added call %s with delay %s. %d calls in list. Result set: %s", msg.getValue("id"), delay.c_str(), m_hash.count(), dbg.c_str());
+    ForwardRec* rec = new ForwardRec(msg.getValue("id"),
+                                     getCell(result, 0, 1),
+                                     delay,
+                                     mode,
+                                     data);
+    for (int j = 1; j < result->getRows(); j++)
+        rec->addTargets(getCell(result, 1, j), getCell(result, 2, j));
+    if (!rec->getTargets().skipNull()) {
+        Debug(&__plugin, DebugInfo, "No forward targets for call %s", msg.getValue("id"));
+        TelEngine::destruct(rec);
+        return false;
+    }
+    Lock lock(this);
+    rec->setSerial(++m_serial);
+    m_hash.append(rec);
+    Debug(&__plugin, DebugMild, "Added call %s with delay %s, targets %s (%s). %d calls in list. Result set: %s",
+          msg.getValue("id"), delay.c_str(), rec->getForwardTo().c_str(), lookup(mode, s_modes, "unknown"),
+          m_hash.count(), dbg.c_str());
+    // resolve targets while the call rings so no-answer can skip routing
+    if (m_preroute) {
+        for (ObjList* o = rec->getTargets().skipNull(); o; o = o->skipNext()) {
+            ForwardRoute* m = new ForwardRoute(rec, *static_cast<ForwardTarget*>(o->get()));
+            if (!Engine::enqueue(m))
+                TelEngine::destruct(m);
+        }
+    }
     msg.setParam("maxcall", delay);
     return false;
 }
 
+ForwardRoute::ForwardRoute(ForwardRec* rec, const String& number)
+    : Message("call.route"), m_id(rec->name()), m_serial(rec->getSerial()), m_number(number)
+{
+    addParam("caller", *rec);
+    addParam("callername", *rec);
+    addParam("called", number);
+    __plugin.routeStarted();
+}
+
+ForwardRoute::~ForwardRoute()
+{
+    __plugin.routeDone();
+}
+
+void ForwardRoute::dispatched(bool accepted)
+{
+    if (validRoute(*this, accepted))
+        __plugin.routed(m_id, m_serial, m_number, retValue());
+    else
+        Debug(&__plugin, DebugInfo, "Preroute of %s for call %s failed", m_number.c_str(), m_id.c_str());
+}
+
+// count background routes, the module can't unload while any is queued
+void ForwarderModule::routeStarted()
+{
+    Lock lock(this);
+    m_routes++;
+}
+
+void ForwarderModule::routeDone()
+{
+    Lock lock(this);
+    m_routes--;
+}
+
+// store background route result if the call is still waiting to forward
+void ForwarderModule::routed(const String& id, unsigned int serial, const String& number, const String& callto)
+{
+    Lock lock(this);
+    ForwardRec* rec = findRec(id);
+    if (!(rec && rec->getSerial() == serial))
+        return;
+    // a number may be listed more than once, cache it for every entry
+    for (ObjList* o = rec->getTargets().skipNull(); o; o = o->skipNext()) {
+        ForwardTarget* target = static_cast<ForwardTarget*>(o->get());
+        if (*target == number)
+            target->setRoute(callto);
+    }
+    Debug(&__plugin, DebugAll, "Prerouted %s for call %s to %s", number.c_str(), id.c_str(), callto.c_str());
+}
+
+ForwardRec* ForwarderModule::findRec(const String& id)
+{
+    GenObject* obj = m_hash[id];
+    return obj ? static_cast<ForwardRec*>(obj->getObject("ForwardRec")) : 0;
+}
+
+// route a single forward target number, return resulting callto
+bool ForwarderModule::routeTarget(ForwardRec* rec, ForwardTarget* target, String& callto)
+{
+    callto = target->getRoute(m_preroute_expire);
+    if (callto)
+        return true;
+    Message m("call.route");
+    m.setParam("caller", (String)rec);
+    m.setParam("callername", (String)rec);
+    m.setParam("called", *target);
+    if (!validRoute(m, Engine::dispatch(m))) {
+        Debug(&__plugin,DebugWarn,"Forwarded call from %s to %s routing failed",
+              rec->c_str(), target->c_str());
+        return false;
+    }
+    callto = m.retValue();
+    return true;
+}
+
+// fill callto of the forward execute message, use a fork for several targets
+bool ForwarderModule::buildCallto(ForwardRec* rec, Message& exec)
+{
+    ObjList legs;
+    for (ObjList* o = rec->getTargets().skipNull(); o; o = o->skipNext()) {
+        ForwardTarget* target = static_cast<ForwardTarget*>(o->get());
+        String callto;
+        if (routeTarget(rec, target, callto))
+            legs.append(new NamedString(callto, target->getDelay()));
+    }
+    ObjList* o = legs.skipNull();
+    if (!o)
+        return false;
+    if (!o->skipNext()) {
+        exec.setParam("callto", static_cast<NamedString*>(o->get())->name());
+        return true;
+    }
+    // callfork: first answered leg wins, the others get dropped
+    exec.setParam("callto", "fork");
+    int n = 0;
+    NamedString* prev = 0;
+    for (; o; o = o->skipNext()) {
+        NamedString* leg = static_cast<NamedString*>(o->get());
+        String param;
+        if (prev && rec->getMode() == ForwardRec::Sequential) {
+            // hunt: ring the previous leg for its delay, then move on
+            String sep("|");
+            if (prev->toInteger() > 0)
+                sep << "drop=" << prev->toInteger();
+            param << "callto." << ++n;
+            exec.setParam(param, sep);
+            param.clear();
+        }
+        param << "callto." << ++n;
+        exec.setParam(param, leg->name());
+        prev = leg;
+    }
+    return true;
+}
+
 bool ForwarderModule::msgDisconnected(Message& msg)
 {
     Debug(&__plugin, DebugMild, "Processing disconnected %s to %s, reason: %s",
           msg.getValue("id"), msg.getValue("targetid"), msg.getValue("reason"));
-    ForwardRec *rec;
-    GenObject* obj;
+    Lock lock(this);
     String id = msg.getValue("targetid");
-    obj = m_hash[id];
-    if (obj){
-        rec = static_cast<ForwardRec*>(obj->getObject("ForwardRec"));
-        if (rec) {
-            m_hash.remove(rec, true);
-            Debug(&__plugin, DebugMild, "Deleted call %s. %d calls remaining", id.c_str(), m_hash.count());
-            return false;
-        }
+    ForwardRec* rec = findRec(id);
+    if (rec) {
+        m_hash.remove(rec, true);
+        Debug(&__plugin, DebugMild, "Deleted call %s. %d calls remaining", id.c_str(), m_hash.count());
+        return false;
     }
     id = msg.getValue("id");
-    obj = m_hash[id];
-    if (!obj)
-        return false;
-    rec = static_cast<ForwardRec*>(obj->getObject("ForwardRec"));
+    rec = findRec(id);
     if (!rec)
         return false;
+    // detach the record so forwarding runs unlocked and prerouting stops
+    m_hash.remove(rec, false);
+    Debug(&__plugin, DebugMild, "Deleted call %s. %d calls remaining", id.c_str(), m_hash.count());
     String reason = static_cast<String>(msg.getParam("reason"));
-    if (reason == "noanswer" || reason == "noroute" || reason == "looping") {
-        Debug(&__plugin, DebugMild, "Route call to %s", rec->getForwardTo().c_str());
-        Message m("call.route");
-        m.setParam("caller", (String)rec);
-        m.setParam("callername", (String)rec);
-        m.setParam("called", rec->getForwardTo());
-        if (!Engine::dispatch(m) || (m.retValue() == "-") || (m.retValue() == "error")) {
-            Debug(&__plugin,DebugWarn,"Forwarded call from %s to %s routing failed",
-                  rec->c_str(), rec->getForwardTo().c_str());
-            return false;
-        }
-        Message exec("call.execute");
+    if (!(reason == "noanswer" || reason == "noroute" || reason == "looping")) {
+        lock.drop();
+        TelEngine::destruct(rec);
+        return false;
+    }
+    // hand the forward to the workers so disconnect processing goes on
+    // the caller stays peerless until a worker runs the job, accepting the
+    // message keeps it from being hung up meanwhile
+    if (m_workers > 0 && !m_stopping && (!m_maxQueue || m_jobsCount < m_maxQueue)) {
+        m_jobs.append(new ForwardJob(id, rec));
+        m_queued++;
+        if (++m_jobsCount > m_queuePeak)
+            m_queuePeak = m_jobsCount;
+        m_jobsSem.unlock();
+        return true;
+    }
+    if (m_workers > 0 && !m_stopping) {
+        m_overflow++;
+        Debug(&__plugin, DebugMild, "Forward queue full, forwarding call %s inline", id.c_str());
+    }
+    lock.drop();
+    forward(id, rec, false);
+    TelEngine::destruct(rec);
+    return false;
+}
+
+// route and execute the forward leg of a no-answered call
+// if drop is set the caller is dropped when it can't be forwarded
+void ForwarderModule::forward(const String& id, ForwardRec* rec, bool drop)
+{
+    // the caller may have hung up or got a peer while the job was queued
+    int state = callerState(rec->getUserData());
+    if (state != CallerWaiting) {
+        Debug(&__plugin, DebugInfo, "Caller of call %s is %s, forward canceled",
+              id.c_str(), state == CallerConnected ? "connected" : "gone");
+        lock();
+        m_canceled++;
+        unlock();
+        if (drop && state == CallerGone)
+            dropCaller(id);
+        return;
+    }
+    Debug(&__plugin, DebugMild, "Route call to %s", rec->getForwardTo().c_str());
+    Message exec("call.execute");
+    bool ok = buildCallto(rec, exec);
+    if (ok) {
         exec.userData(rec->getUserData());
         exec.setParam("id", id);
         exec.setParam("caller", (String)rec);
         exec.setParam("callername", (String)rec);
-        exec.setParam("called", rec->getForwardTo());
+        exec.setParam("called", *static_cast<String*>(rec->getTargets().skipNull()->get()));
         exec.setParam("status", "outgoing");
-        exec.setParam("callto", m.retValue());
-        Engine::dispatch(exec);
+        ok = Engine::dispatch(exec);
+        if (!ok)
+            Debug(&__plugin, DebugWarn, "Forward of call %s to %s failed", id.c_str(), exec.getValue("callto"));
     }
-    m_hash.remove(rec, true);
-    Debug(&__plugin, DebugMild, "Deleted call %s. %d calls remaining", id.c_str(), m_hash.count());
-    return false;
+    lock();
+    if (ok)
+        m_forwarded++;
+    else
+        m_failed++;
+    unlock();
+    if (drop && !ok)
+        dropCaller(id);
+}
+
+// wait for the next queued forward, returns NULL when the worker must exit
+ForwardJob* ForwarderModule::getJob()
+{
+    while (!Thread::check(false)) {
+        lock();
+        ForwardJob* job = m_stopping ? 0 : static_cast<ForwardJob*>(m_jobs.remove(false));
+        if (job)
+            m_jobsCount--;
+        // surplus workers leave once the queue is drained
+        if (!job && (m_stopping || m_workers > m_maxWorkers)) {
+            m_workers--;
+            unlock();
+            return 0;
+        }
+        if (job)
+            m_busy++;
+        unlock();
+        if (job)
+            return job;
+        m_jobsSem.lock(100000);
+    }
+    lock();
+    m_workers--;
+    unlock();
+    return 0;
+}
+
+ForwardWorker::ForwardWorker()
+    : Thread("Forwarder Worker")
+{
+    __plugin.threadStarted();
+}
+
+// the thread count drops last so unload can't pull the module from under us
+ForwardWorker::~ForwardWorker()
+{
+    __plugin.threadDone();
+}
+
+void ForwardWorker::run()
+{
+    while (ForwardJob* job = __plugin.getJob()) {
+        __plugin.forward(job->getId(), job->getRec(), true);
+        __plugin.jobDone(job);
+    }
+}
+
+void ForwarderModule::threadStarted()
+{
+    Lock lock(this);
+    m_threads++;
+}
+
+void ForwarderModule::threadDone()
+{
+    Lock lock(this);
+    m_threads--;
+}
+
+void ForwarderModule::jobDone(ForwardJob* job)
+{
+    TelEngine::destruct(job);
+    Lock lock(this);
+    m_busy--;
+}
+
+// start workers up to the configured count, module must be locked
+void ForwarderModule::startWorkers()
+{
+    while (m_workers < m_maxWorkers) {
+        ForwardWorker* worker = new ForwardWorker;
+        if (!worker->startup()) {
+            Debug(&__plugin, DebugWarn, "Could not start forwarder worker");
+            delete worker;
+            break;
+        }
+        m_workers++;
+    }
+}
+
+void ForwarderModule::statusParams(String& str)
+{
+    Lock lock(this);
+    str.append("calls=",",") << m_hash.count();
+    str << ",workers=" << m_workers;
+    str << ",queue=" << m_jobsCount;
+    str << ",queued=" << m_queued;
+    str << ",peak=" << m_queuePeak;
+    str << ",overflow=" << m_overflow;
+    str << ",busy=" << m_busy;
+    str << ",forwarded=" << m_forwarded;
+    str << ",failed=" << m_failed;
+    str << ",canceled=" << m_canceled;
 }
 
 bool ForwarderModule::msgAnswered(Message &msg)
 {
     String id = msg.getValue("targetid");
-    GenObject *obj = m_hash[id];
-    if (!obj)
-        return false;
-    ForwardRec *rec = (ForwardRec*)obj->getObject("ForwardRec");
+    Lock lock(this);
+    ForwardRec* rec = findRec(id);
     if (!rec)
         return false;
     m_hash.remove(rec, true);
@@ -249,7 +793,12 @@ bool ForwarderModule::received(Message& msg, int id)
 
 ForwarderModule::ForwarderModule()
     : Module("forwarder","misc",true),
-      m_init(false)
+      m_init(false), m_mode(ForwardRec::Parallel),
+      m_preroute(true), m_preroute_expire(60000), m_serial(0), m_routes(0),
+      m_jobsCount(0), m_jobsSem(0x7fffffff, "Forwarder Jobs", 0),
+      m_stopping(false), m_workers(0), m_threads(0), m_maxWorkers(4), m_maxQueue(100),
+      m_queued(0), m_queuePeak(0), m_overflow(0), m_forwarded(0),
+      m_failed(0), m_canceled(0), m_busy(0)
 {
     Output("Loaded module Forwarder");
 }
@@ -266,9 +815,14 @@ void ForwarderModule::initialize()
     lock();
     m_account = cfg.getValue("general","account");
     m_get_query = cfg.getValue("general","query");
+    m_mode = getMode(cfg.getValue("general","mode"), ForwardRec::Parallel);
+    m_preroute = cfg.getBoolValue("general","preroute", true);
+    m_preroute_expire = cfg.getIntValue("general","preroute_expire", 60000, 0, 3600000, true);
     m_disconnected_pri =  cfg.getIntValue("priorities","chan.disconnected", 1, 0, 100, true);
     m_execute_pri = cfg.getIntValue("priorities","call.execute", 10, 0, 100, true);
     m_answered_pri = cfg.getIntValue("priorities","call.answered", 10, 0, 100, true);
+    m_maxWorkers = cfg.getIntValue("general","workers", 4, 0, 64, true);
+    m_maxQueue = cfg.getIntValue("general","maxqueue", 100, 0, 10000, true);
     unlock();
     if (!m_init && !m_account.null() && !m_get_query.null()) {
         setup();
@@ -277,6 +831,11 @@ void ForwarderModule::initialize()
         installRelay(CallAnswered, "call.answered", m_answered_pri);
         m_init = true;
     }
+    if (m_init) {
+        lock();
+        startWorkers();
+        unlock();
+    }
 }
 
 }; // anonymous namespace